@@ -32,6 +32,7 @@ FOUNDATION_EXPORT const unsigned char SMTorVersionString[];
 
 #import <SMTor/SMTorManager.h>
 #import <SMTor/SMTorConfiguration.h>
+#import <SMTor/SMTorPerformanceOptions.h>
 
 #import <SMTor/SMTorStartController.h>
 #import <SMTor/SMTorUpdateController.h>
@@ -22,6 +22,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import <SMTor/SMTorPerformanceOptions.h>
+
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -44,18 +46,30 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic)			uint16_t	hiddenServiceRemotePort;
 
-@property (nonatomic)			NSString	*hiddenServiceLocalHost;
+@property (nullable, nonatomic) NSString	*hiddenServiceLocalHost;
 @property (nonatomic)			uint16_t	hiddenServiceLocalPort;
 
+@property (nullable, nonatomic) NSString	*hiddenServiceLocalUnixPath; // If set, used instead of local host & port.
+
+// -- Control --
+@property (nonatomic)			BOOL		controlUnixSocket; // Connect to tor control through a unix socket in data path.
+
 // -- Path --
 @property (nonatomic)			NSString	*binaryPath;
 @property (nonatomic)			NSString	*dataPath;
 
+// -- Performance --
+@property (nonatomic, copy)		SMTorPerformanceOptions *performanceOptions;
+
+// -- Shutdown --
+@property (nonatomic)			NSTimeInterval	shutdownTimeout; // Delay given to tor to exit gracefully before being killed.
+
 
 // -- Tools --
 @property (readonly, getter=isValid) BOOL valid;
 
 - (BOOL)differFromConfiguration:(SMTorConfiguration *)configuration;
+- (BOOL)requireRelaunchFromConfiguration:(SMTorConfiguration *)configuration; // Differences which can't be applied on a running tor.
 
 @end
 
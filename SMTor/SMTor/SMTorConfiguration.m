@@ -20,12 +20,26 @@
  *
  */
 
+#include <sys/socket.h>
+#include <sys/un.h>
+
 #import "SMTorConfiguration.h"
 
+#import "SMTorConstants.h"
+
 
 NS_ASSUME_NONNULL_BEGIN
 
 
+/*
+** Prototypes
+*/
+#pragma mark - Prototypes
+
+static BOOL unix_path_valid(NSString * _Nullable path);
+
+
+
 /*
 ** SMTorConfiguration
 */
@@ -33,6 +47,22 @@ NS_ASSUME_NONNULL_BEGIN
 
 @implementation SMTorConfiguration
 
+- (instancetype)init
+{
+	self = [super init];
+	
+	if (self)
+	{
+		// Performance.
+		_performanceOptions = [[SMTorPerformanceOptions alloc] init];
+		
+		// Shutdown.
+		_shutdownTimeout = SMTorDefaultShutdownTimeout;
+	}
+	
+	return self;
+}
+
 - (id)copyWithZone:(nullable NSZone *)zone
 {
 	SMTorConfiguration *copy = [[SMTorConfiguration allocWithZone:zone] init];
@@ -47,15 +77,38 @@ NS_ASSUME_NONNULL_BEGIN
 	copy.hiddenServiceRemotePort = _hiddenServiceRemotePort;
 	copy.hiddenServiceLocalHost = [_hiddenServiceLocalHost copy];
 	copy.hiddenServiceLocalPort = _hiddenServiceLocalPort;
+	copy.hiddenServiceLocalUnixPath = [_hiddenServiceLocalUnixPath copy];
+
+	// Control.
+	copy.controlUnixSocket = _controlUnixSocket;
 
 	// Path.
 	copy.binaryPath = [_binaryPath copy];
 	copy.dataPath = [_dataPath copy];
 
+	// Performance.
+	copy.performanceOptions = _performanceOptions;
+
+	// Shutdown.
+	copy.shutdownTimeout = _shutdownTimeout;
+
 	return copy;
 }
 
 - (BOOL)differFromConfiguration:(SMTorConfiguration *)configuration
+{
+	BOOL differ = [self requireRelaunchFromConfiguration:configuration];
+	
+	// Performance.
+	differ = differ || [_performanceOptions differFromOptions:configuration.performanceOptions];
+	
+	// Shutdown.
+	differ = differ || (_shutdownTimeout != configuration.shutdownTimeout);
+	
+	return differ;
+}
+
+- (BOOL)requireRelaunchFromConfiguration:(SMTorConfiguration *)configuration
 {
 	BOOL differ = NO;
 	
@@ -71,14 +124,25 @@ NS_ASSUME_NONNULL_BEGIN
 		differ = differ || (_hiddenServicePrivateKey != configuration.hiddenServicePrivateKey);
 		differ = differ || ([_hiddenServicePrivateKey isEqualToString:(NSString *)configuration.hiddenServicePrivateKey] == NO);
 		differ = differ || (_hiddenServiceRemotePort != configuration.hiddenServiceRemotePort);
-		differ = differ || ([_hiddenServiceLocalHost isEqualToString:configuration.hiddenServiceLocalHost] == NO);
-		differ = differ || (_hiddenServiceLocalPort != configuration.hiddenServiceLocalPort);
+		differ = differ || (_hiddenServiceLocalUnixPath != configuration.hiddenServiceLocalUnixPath && [_hiddenServiceLocalUnixPath isEqualToString:(NSString *)configuration.hiddenServiceLocalUnixPath] == NO);
+		
+		if (!configuration.hiddenServiceLocalUnixPath)
+		{
+			differ = differ || (_hiddenServiceLocalHost != configuration.hiddenServiceLocalHost && [_hiddenServiceLocalHost isEqualToString:(NSString *)configuration.hiddenServiceLocalHost] == NO);
+			differ = differ || (_hiddenServiceLocalPort != configuration.hiddenServiceLocalPort);
+		}
 	}
 	
+	// Control.
+	differ = differ || (_controlUnixSocket != configuration.controlUnixSocket);
+	
 	// Path.
 	differ = differ || ([_binaryPath isEqualToString:configuration.binaryPath] == NO);
 	differ = differ || ([_dataPath isEqualToString:configuration.dataPath] == NO);
 	
+	// Performance.
+	differ = differ || [_performanceOptions requireRelaunchFromOptions:configuration.performanceOptions];
+	
 	return differ;
 }
 
@@ -94,18 +158,57 @@ NS_ASSUME_NONNULL_BEGIN
 	if (_hiddenService)
 	{
 		valid = valid && (_hiddenServiceRemotePort > 1);
-		valid = valid && (_hiddenServiceLocalHost != nil);
-		valid = valid && (_hiddenServiceLocalPort > 1);
+		
+		if (_hiddenServiceLocalUnixPath)
+			valid = valid && unix_path_valid(_hiddenServiceLocalUnixPath);
+		else
+		{
+			valid = valid && (_hiddenServiceLocalHost != nil);
+			valid = valid && (_hiddenServiceLocalPort > 1);
+		}
 	}
+	
+	// Control.
+	if (_controlUnixSocket)
+		valid = valid && unix_path_valid([_dataPath stringByAppendingPathComponent:SMTorControlSocketFile]);
 
 	// Path.
 	valid = valid && (_binaryPath != nil);
 	valid = valid && (_dataPath != nil);
 	
+	// Performance.
+	valid = valid && (_performanceOptions != nil);
+	valid = valid && _performanceOptions.isValid;
+	
+	// Shutdown.
+	valid = valid && (_shutdownTimeout >= 0);
+	
 	return valid;
 }
 
 @end
 
 
+
+/*
+** C Tools
+*/
+#pragma mark - C Tools
+
+static BOOL unix_path_valid(NSString * _Nullable path)
+{
+	if (!path || [path isAbsolutePath] == NO)
+		return NO;
+	
+	// Tor control protocol arguments are space separated.
+	if ([path rangeOfCharacterFromSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]].location != NSNotFound)
+		return NO;
+	
+	// Must fit in a sockaddr_un.
+	struct sockaddr_un addr;
+	
+	return (strlen(path.fileSystemRepresentation) < sizeof(addr.sun_path));
+}
+
+
 NS_ASSUME_NONNULL_END
@@ -26,6 +26,11 @@
 
 // Control.
 #define SMTorControlHostFile	@"tor_ctrl"
+#define SMTorControlSocketFile	@"tor_ctrl.sock"
+
+
+// Shutdown.
+#define SMTorDefaultShutdownTimeout	2.0	// seconds
 
 
 // Local binary directory.
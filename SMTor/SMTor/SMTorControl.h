@@ -39,7 +39,8 @@ NS_ASSUME_NONNULL_BEGIN
 @property (strong, atomic) void (^socketError)(SMInfo *info);
 
 // -- Instance --
-- (nullable instancetype)initWithIP:(NSString *)ip port:(uint16_t)port NS_DESIGNATED_INITIALIZER;
+- (nullable instancetype)initWithIP:(NSString *)ip port:(uint16_t)port;
+- (nullable instancetype)initWithUnixSocketPath:(NSString *)path;
 
 - (instancetype)init NS_UNAVAILABLE;
 
@@ -50,7 +51,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)sendAuthenticationCommandWithKeyHexa:(NSString *)keyHexa resultHandler:(void (^)(BOOL success))handler;
 - (void)sendGetInfoCommandWithInfo:(NSString *)info resultHandler:(void (^)(BOOL success, NSString * _Nullable info))handler;
 - (void)sendSetEventsCommandWithEvents:(NSString *)events resultHandler:(void (^)(BOOL success))handler;
-- (void)sendAddOnionCommandWithPrivateKey:(nullable NSString *)privateKey port:(NSString *)servicePort resultHandler:(void (^)(BOOL success, NSString * _Nullable serviceID, NSString * _Nullable privateKey))handler;
+- (void)sendSignalCommandWithSignal:(NSString *)signal resultHandler:(void (^)(BOOL success))handler;
+- (void)sendSetConfCommandWithOptions:(NSDictionary<NSString *, NSString *> *)options resultHandler:(void (^)(BOOL success))handler; // Empty value reset option to its default.
+- (void)sendAddOnionCommandWithPrivateKey:(nullable NSString *)privateKey port:(NSString *)servicePort maxStreams:(NSUInteger)maxStreams resultHandler:(void (^)(BOOL success, NSString * _Nullable serviceID, NSString * _Nullable privateKey))handler;
 
 // -- Helpers --
 + (nullable NSDictionary *)parseNoticeBootstrap:(NSString *)line;
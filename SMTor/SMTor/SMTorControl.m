@@ -21,6 +21,9 @@
  */
 
 
+#include <sys/socket.h>
+#include <sys/un.h>
+
 #import "SMTorControl.h"
 
 
@@ -35,6 +38,19 @@ NS_ASSUME_NONNULL_BEGIN
 typedef void (^SMTorControlLineHandler)(NSNumber *code, NSString * _Nullable line, BOOL *finished);
 
 
+/*
+** SMTorControl - Private
+*/
+#pragma mark - SMTorControl - Private
+
+@interface SMTorControl ()
+
+- (instancetype)initWithSocket:(SMSocket *)socket NS_DESIGNATED_INITIALIZER;
+
+@end
+
+
+
 /*
 ** SMTorControl
 */
@@ -59,24 +75,75 @@ typedef void (^SMTorControlLineHandler)(NSNumber *code, NSString * _Nullable lin
 #pragma mark - SMTorControl - Instance
 
 - (nullable instancetype)initWithIP:(NSString *)ip port:(uint16_t)port
+{
+	NSAssert(ip, @"ip is nil");
+	
+	// Socket.
+	SMSocket *ctrlSocket = [[SMSocket alloc] initWithIP:ip port:port];
+	
+	if (!ctrlSocket)
+		return nil;
+	
+	SMDebugLog(@"Connected to Tor Control (%@:%d)", ip, port);
+	
+	return [self initWithSocket:ctrlSocket];
+}
+
+- (nullable instancetype)initWithUnixSocketPath:(NSString *)path
+{
+	NSAssert(path, @"path is nil");
+	
+	// Build address.
+	struct sockaddr_un	addr;
+	const char			*fsPath = path.fileSystemRepresentation;
+	
+	memset(&addr, 0, sizeof(addr));
+	
+	if (strlen(fsPath) >= sizeof(addr.sun_path))
+		return nil;
+	
+	addr.sun_family = AF_UNIX;
+	strlcpy(addr.sun_path, fsPath, sizeof(addr.sun_path));
+	
+	// Connect.
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	
+	if (fd == -1)
+		return nil;
+	
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+	{
+		close(fd);
+		return nil;
+	}
+	
+	// Socket.
+	SMSocket *ctrlSocket = [[SMSocket alloc] initWithSocket:fd];
+	
+	if (!ctrlSocket)
+	{
+		close(fd);
+		return nil;
+	}
+	
+	SMDebugLog(@"Connected to Tor Control (%@)", path);
+	
+	return [self initWithSocket:ctrlSocket];
+}
+
+- (instancetype)initWithSocket:(SMSocket *)socket
 {
 	self = [super init];
 	
 	if (self)
 	{
-		NSAssert(ip, @"ip is nil");
+		NSAssert(socket, @"socket is nil");
 		
 		// Queues.
 		_localQueue = dispatch_queue_create("com.smtor.tor-control.local", DISPATCH_QUEUE_SERIAL);
 		
 		// Socket.
-		_socket = [[SMSocket alloc] initWithIP:ip port:port];
-		
-		if (!_socket)
-			return nil;
-		
-		SMDebugLog(@"Connected to Tor Control (%@:%d)", ip, port);
-		
+		_socket = socket;
 		_socket.delegate = self;
 		
 		[_socket setGlobalOperation:SMSocketOperationLine size:0 tag:0];
@@ -206,7 +273,60 @@ typedef void (^SMTorControlLineHandler)(NSNumber *code, NSString * _Nullable lin
 	});
 }
 
-- (void)sendAddOnionCommandWithPrivateKey:(nullable NSString *)privateKey port:(NSString *)servicePort resultHandler:(void (^)(BOOL success, NSString * _Nullable serviceID, NSString * _Nullable privateKey))handler
+- (void)sendSignalCommandWithSignal:(NSString *)signal resultHandler:(void (^)(BOOL success))handler
+{
+	NSAssert(signal, @"signal is nil");
+	NSAssert(handler, @"handler is nil");
+	
+	dispatch_async(_localQueue, ^{
+		
+		NSData *command = [[NSString stringWithFormat:@"SIGNAL %@\n", signal] dataUsingEncoding:NSASCIIStringEncoding];
+		
+		[self _addHandler:^(NSNumber * _Nonnull code, NSString * _Nullable line, BOOL * _Nonnull finished) {
+			*finished = YES;
+			handler(code.integerValue == 250);
+		}];
+		
+		[_socket sendBytes:command.bytes size:command.length copy:YES];
+	});
+}
+
+- (void)sendSetConfCommandWithOptions:(NSDictionary<NSString *, NSString *> *)options resultHandler:(void (^)(BOOL success))handler
+{
+	NSAssert(options, @"options is nil");
+	NSAssert(handler, @"handler is nil");
+	
+	dispatch_async(_localQueue, ^{
+		
+		// Forge command.
+		NSMutableString *commandStr = [NSMutableString stringWithString:@"SETCONF"];
+		
+		for (NSString *key in options)
+		{
+			NSString *value = options[key];
+			
+			if (value.length > 0)
+				[commandStr appendFormat:@" %@=%@", key, value];
+			else
+				[commandStr appendFormat:@" %@", key];
+		}
+		
+		[commandStr appendString:@"\n"];
+		
+		NSData *command = [commandStr dataUsingEncoding:NSASCIIStringEncoding];
+		
+		// Handle command result.
+		[self _addHandler:^(NSNumber * _Nonnull code, NSString * _Nullable line, BOOL * _Nonnull finished) {
+			*finished = YES;
+			handler(code.integerValue == 250);
+		}];
+		
+		// Send command.
+		[_socket sendBytes:command.bytes size:command.length copy:YES];
+	});
+}
+
+- (void)sendAddOnionCommandWithPrivateKey:(nullable NSString *)privateKey port:(NSString *)servicePort maxStreams:(NSUInteger)maxStreams resultHandler:(void (^)(BOOL success, NSString * _Nullable serviceID, NSString * _Nullable privateKey))handler
 {
 	NSAssert(servicePort, @"servicePort is nil");
 	NSAssert(handler, @"handler is nil");
@@ -214,12 +334,13 @@ typedef void (^SMTorControlLineHandler)(NSNumber *code, NSString * _Nullable lin
 	dispatch_async(_localQueue, ^{
 		
 		// Forge command.
+		NSString *limits = (maxStreams > 0 ? [NSString stringWithFormat:@" MaxStreams=%lu", (unsigned long)maxStreams] : @"");
 		NSData *command;
 		
 		if (privateKey)
-			command = [[NSString stringWithFormat:@"ADD_ONION %@ Flags=Detach Port=%@\n", privateKey, servicePort] dataUsingEncoding:NSASCIIStringEncoding];
+			command = [[NSString stringWithFormat:@"ADD_ONION %@ Flags=Detach%@ Port=%@\n", privateKey, limits, servicePort] dataUsingEncoding:NSASCIIStringEncoding];
 		else
-			command = [[NSString stringWithFormat:@"ADD_ONION NEW:RSA1024 Flags=Detach Port=%@\n", servicePort] dataUsingEncoding:NSASCIIStringEncoding];
+			command = [[NSString stringWithFormat:@"ADD_ONION NEW:RSA1024 Flags=Detach%@ Port=%@\n", limits, servicePort] dataUsingEncoding:NSASCIIStringEncoding];
 		
 		// Handle command result.
 		__block NSString *resultServiceID = nil;
@@ -113,13 +113,15 @@ static BOOL	version_greater(NSString * _Nullable baseVersion, NSString * _Nullab
 		// Handle application standard termination.
 		_terminationObserver = [[NSNotificationCenter defaultCenter] addObserverForName:NSApplicationWillTerminateNotification object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
 			
-			dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+			// Tor is killed once the shutdown timeout is reached: wait a bit more than that.
+			NSTimeInterval			timeout = self.configuration.shutdownTimeout + 0.5;
+			dispatch_semaphore_t	semaphore = dispatch_semaphore_create(0);
 
 			[self stopWithCompletionHandler:^{
 				dispatch_semaphore_signal(semaphore);
 			}];
 			
-			dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 2 * NSEC_PER_SEC));
+			dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeout * NSEC_PER_SEC)));
 		}];
 		
 		// SIGTERM handle.
@@ -677,6 +679,43 @@ static BOOL	version_greater(NSString * _Nullable baseVersion, NSString * _Nullab
 		
 		SMOperationsQueue *queue = [[SMOperationsQueue alloc] init];
 		
+		// -- Apply live --
+		[queue scheduleOnQueue:_localQueue block:^(SMOperationsControl ctrl) {
+			
+			if ([_configuration requireRelaunchFromConfiguration:configuration])
+			{
+				ctrl(SMOperationsControlContinue);
+				return;
+			}
+			
+			// > Not running, or nothing to change in tor: just keep the configuration.
+			if (!_torTask || [_configuration.performanceOptions differFromOptions:configuration.performanceOptions] == NO)
+			{
+				_configuration = configuration;
+				_torTask.shutdownTimeout = configuration.shutdownTimeout;
+				ctrl(SMOperationsControlFinish);
+				return;
+			}
+			
+			// > Running, change tor options in place (fallback on a relaunch if it doesn't work).
+			SMDebugLog(@" -> Apply performance options.");
+			
+			[_torTask applyPerformanceOptions:configuration.performanceOptions completionHandler:^(BOOL success) {
+				
+				dispatch_async(_localQueue, ^{
+					
+					if (success)
+					{
+						_configuration = configuration;
+						_torTask.shutdownTimeout = configuration.shutdownTimeout;
+						ctrl(SMOperationsControlFinish);
+					}
+					else
+						ctrl(SMOperationsControlContinue);
+				});
+			}];
+		}];
+		
 		// -- Stop Tor --
 		__block BOOL needTorRelaunch = NO;
 		
@@ -27,6 +27,7 @@
 #import "SMTorOperations.h"
 
 #import "SMTorConfiguration.h"
+#import "SMTorProcess.h"
 
 #import "SMPublicKey.h"
 #import "SMTorConstants.h"
@@ -101,31 +102,22 @@ static NSData * _Nullable file_sha256(NSURL *fileURL);
 	[profile appendFormat:@"(allow file-read* (subpath \"/Applications\"))"];	// Allow to read Applications.
 #endif
 	
-	// Create & launch task.
-	NSTask *task = [[NSTask alloc] init];
+	// Create & launch process - tar changes directory by itself (-C), as posix_spawn can't do it for us.
+	NSArray			*tarArgs = @[ @"-p", profile, @"/usr/bin/tar", @"-x", @"-z", @"-f", newFilePath, @"-C", targetDirectory.path, @"--strip-components", @"1" ];
+	SMTorProcess	*process = [[SMTorProcess alloc] initWithLaunchPath:@"/usr/bin/sandbox-exec" arguments:tarArgs];
 	
-	task.launchPath = @"/usr/bin/sandbox-exec";
-	task.currentDirectoryPath = targetDirectory.path;
-	
-	task.arguments = @[ @"-p", profile, @"/usr/bin/tar", @"-x", @"-z", @"-f", newFilePath.lastPathComponent, @"--strip-components", @"1" ];
-	
-	[task setStandardError:nil];
-	[task setStandardOutput:nil];
-	
-	task.terminationHandler = ^(NSTask *aTask) {
+	process.terminationHandler = ^(SMTorProcess *aProcess) {
 		
-		if (aTask.terminationStatus != 0)
-			handler([SMInfo infoOfKind:SMInfoError domain:SMTorInfoOperationDomain code:SMTorErrorOperationExtract context:@(aTask.terminationStatus)]);
+		if (aProcess.terminationStatus != 0)
+			handler([SMInfo infoOfKind:SMInfoError domain:SMTorInfoOperationDomain code:SMTorErrorOperationExtract context:@(aProcess.terminationStatus)]);
 		else
 			handler([SMInfo infoOfKind:SMInfoInfo domain:SMTorInfoOperationDomain code:SMTorEventOperationDone]);
 		
 		[fileManager removeItemAtPath:newFilePath error:nil];
 	};
 	
-	@try {
-		[task launch];
-	}
-	@catch (NSException *exception) {
+	if ([process launch] == NO)
+	{
 		handler([SMInfo infoOfKind:SMInfoError domain:SMTorInfoOperationDomain code:SMTorErrorOperationExtract context:@(-1)]);
 		[fileManager removeItemAtPath:newFilePath error:nil];
 	}
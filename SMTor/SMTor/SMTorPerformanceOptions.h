@@ -0,0 +1,65 @@
+/*
+ *  SMTorPerformanceOptions.h
+ *
+ *  Copyright 2019 Avérous Julien-Pierre
+ *
+ *  This file is part of SMTor.
+ *
+ *  SMTor is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SMTor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with SMTor.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+
+/*
+** SMTorPerformanceOptions
+*/
+#pragma mark - SMTorPerformanceOptions
+
+// A zero value means "use tor default".
+@interface SMTorPerformanceOptions : NSObject <NSCopying>
+
+// -- Process (applied on launch) --
+@property (nonatomic) NSUInteger		numCPUs;					// NumCPUs
+@property (nonatomic) NSUInteger		connLimit;					// ConnLimit (minimum file descriptors tor requires - it refuses to start above the hard limit)
+
+// -- Circuits & connections (applied live) --
+@property (nonatomic) NSTimeInterval	circuitBuildTimeout;		// CircuitBuildTimeout (>= 10 s) - only the starting value, tor then learns its own timeout
+@property (nonatomic) NSTimeInterval	maxCircuitDirtiness;		// MaxCircuitDirtiness - longer values link more of the traffic to the same circuit and exit
+@property (nonatomic) NSTimeInterval	keepalivePeriod;			// KeepalivePeriod
+
+// -- Memory (applied live) --
+@property (nonatomic) NSUInteger		constrainedSocketSize;		// ConstrainedSockets + ConstrainedSockSize (2048 to 262144, multiple of 1024) - shrinks socket buffers to save memory, at the cost of throughput
+
+// -- Hidden Service (applied on launch) --
+@property (nonatomic) NSUInteger		hiddenServiceMaxStreams;	// ADD_ONION MaxStreams (<= 65535)
+
+// -- Tools --
+@property (readonly, getter=isValid) BOOL valid;
+
+- (BOOL)differFromOptions:(SMTorPerformanceOptions *)options;
+- (BOOL)requireRelaunchFromOptions:(SMTorPerformanceOptions *)options;
+
+// -- Tor --
+- (NSArray<NSString *> *)torArguments;
+- (NSDictionary<NSString *, NSString *> *)torLiveOptions; // Empty value means "reset to default".
+
+@end
+
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,211 @@
+/*
+ *  SMTorPerformanceOptions.m
+ *
+ *  Copyright 2019 Avérous Julien-Pierre
+ *
+ *  This file is part of SMTor.
+ *
+ *  SMTor is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SMTor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with SMTor.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "SMTorPerformanceOptions.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+
+/*
+** Defines
+*/
+#pragma mark - Defines
+
+#define SMTorMinCircuitBuildTimeout	10.0
+
+#define SMTorMinConstrainedSockSize	2048
+#define SMTorMaxConstrainedSockSize	262144
+
+#define SMTorMaxNumCPUs				128
+#define SMTorMaxStreams				65535
+
+
+
+/*
+** SMTorPerformanceOptions
+*/
+#pragma mark - SMTorPerformanceOptions
+
+@implementation SMTorPerformanceOptions
+
+
+/*
+** SMTorPerformanceOptions - NSCopying
+*/
+#pragma mark - SMTorPerformanceOptions - NSCopying
+
+- (id)copyWithZone:(nullable NSZone *)zone
+{
+	SMTorPerformanceOptions *copy = [[SMTorPerformanceOptions allocWithZone:zone] init];
+	
+	// Process.
+	copy.numCPUs = _numCPUs;
+	copy.connLimit = _connLimit;
+	
+	// Circuits & connections.
+	copy.circuitBuildTimeout = _circuitBuildTimeout;
+	copy.maxCircuitDirtiness = _maxCircuitDirtiness;
+	copy.keepalivePeriod = _keepalivePeriod;
+	
+	// Memory.
+	copy.constrainedSocketSize = _constrainedSocketSize;
+	
+	// Hidden service.
+	copy.hiddenServiceMaxStreams = _hiddenServiceMaxStreams;
+	
+	return copy;
+}
+
+
+
+/*
+** SMTorPerformanceOptions - Tools
+*/
+#pragma mark - SMTorPerformanceOptions - Tools
+
+- (BOOL)differFromOptions:(SMTorPerformanceOptions *)options
+{
+	BOOL differ = [self requireRelaunchFromOptions:options];
+	
+	// Circuits & connections.
+	differ = differ || (_circuitBuildTimeout != options.circuitBuildTimeout);
+	differ = differ || (_maxCircuitDirtiness != options.maxCircuitDirtiness);
+	differ = differ || (_keepalivePeriod != options.keepalivePeriod);
+	
+	// Memory.
+	differ = differ || (_constrainedSocketSize != options.constrainedSocketSize);
+	
+	return differ;
+}
+
+- (BOOL)requireRelaunchFromOptions:(SMTorPerformanceOptions *)options
+{
+	BOOL differ = NO;
+	
+	// Process.
+	differ = differ || (_numCPUs != options.numCPUs);
+	differ = differ || (_connLimit != options.connLimit);
+	
+	// Hidden service.
+	differ = differ || (_hiddenServiceMaxStreams != options.hiddenServiceMaxStreams);
+	
+	return differ;
+}
+
+- (BOOL)isValid
+{
+	BOOL valid = YES;
+	
+	// Process.
+	valid = valid && (_numCPUs <= SMTorMaxNumCPUs);
+	
+	// Circuits & connections.
+	valid = valid && (_circuitBuildTimeout == 0 || _circuitBuildTimeout >= SMTorMinCircuitBuildTimeout);
+	valid = valid && (_maxCircuitDirtiness >= 0);
+	valid = valid && (_keepalivePeriod >= 0);
+	
+	// Memory.
+	if (_constrainedSocketSize != 0)
+	{
+		valid = valid && (_constrainedSocketSize >= SMTorMinConstrainedSockSize);
+		valid = valid && (_constrainedSocketSize <= SMTorMaxConstrainedSockSize);
+		valid = valid && (_constrainedSocketSize % 1024 == 0);
+	}
+	
+	// Hidden service.
+	valid = valid && (_hiddenServiceMaxStreams <= SMTorMaxStreams);
+	
+	return valid;
+}
+
+
+
+/*
+** SMTorPerformanceOptions - Tor
+*/
+#pragma mark - SMTorPerformanceOptions - Tor
+
+- (NSArray<NSString *> *)torArguments
+{
+	NSMutableArray *args = [NSMutableArray array];
+	
+	// Process.
+	if (_numCPUs > 0)
+	{
+		[args addObject:@"--NumCPUs"];
+		[args addObject:[NSString stringWithFormat:@"%lu", (unsigned long)_numCPUs]];
+	}
+	
+	if (_connLimit > 0)
+	{
+		[args addObject:@"--ConnLimit"];
+		[args addObject:[NSString stringWithFormat:@"%lu", (unsigned long)_connLimit]];
+	}
+	
+	// Circuits, connections & memory - set only what differs from tor default.
+	NSDictionary *liveOptions = [self torLiveOptions];
+	
+	for (NSString *key in liveOptions)
+	{
+		NSString *value = liveOptions[key];
+		
+		if (value.length == 0)
+			continue;
+		
+		[args addObject:[@"--" stringByAppendingString:key]];
+		[args addObject:value];
+	}
+	
+	return args;
+}
+
+- (NSDictionary<NSString *, NSString *> *)torLiveOptions
+{
+	NSMutableDictionary *options = [NSMutableDictionary dictionary];
+	
+	NSString * (^seconds)(NSTimeInterval) = ^ NSString * (NSTimeInterval interval) {
+		return (interval > 0 ? [NSString stringWithFormat:@"%.0f", ceil(interval)] : @"");
+	};
+	
+	options[@"CircuitBuildTimeout"] = seconds(_circuitBuildTimeout);
+	options[@"MaxCircuitDirtiness"] = seconds(_maxCircuitDirtiness);
+	options[@"KeepalivePeriod"] = seconds(_keepalivePeriod);
+	
+	if (_constrainedSocketSize > 0)
+	{
+		options[@"ConstrainedSockets"] = @"1";
+		options[@"ConstrainedSockSize"] = [NSString stringWithFormat:@"%lu", (unsigned long)_constrainedSocketSize];
+	}
+	else
+	{
+		options[@"ConstrainedSockets"] = @"";
+		options[@"ConstrainedSockSize"] = @"";
+	}
+	
+	return options;
+}
+
+@end
+
+
+NS_ASSUME_NONNULL_END
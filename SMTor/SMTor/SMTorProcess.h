@@ -0,0 +1,76 @@
+/*
+ *  SMTorProcess.h
+ *
+ *  Copyright 2019 Avérous Julien-Pierre
+ *
+ *  This file is part of SMTor.
+ *
+ *  SMTor is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SMTor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with SMTor.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+
+/*
+** Types
+*/
+#pragma mark - Types
+
+// Bytes are only valid during the call.
+typedef void (^SMTorProcessOutputHandler)(const void *bytes, size_t size);
+
+
+
+/*
+** SMTorProcess
+*/
+#pragma mark - SMTorProcess
+
+@interface SMTorProcess : NSObject
+
+// -- Instance --
+- (instancetype)initWithLaunchPath:(NSString *)launchPath arguments:(NSArray<NSString *> *)arguments NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// -- Handlers --
+// Handlers are called on an internal serial queue, distinct from the one guarding the process state. Output handlers have to be set before launch.
+@property (nullable, strong, atomic) SMTorProcessOutputHandler standardOutputHandler;
+@property (nullable, strong, atomic) SMTorProcessOutputHandler standardErrorHandler;
+
+@property (nullable, strong, atomic) void (^terminationHandler)(SMTorProcess *process);
+
+// -- Properties --
+@property (readonly, atomic) pid_t	processIdentifier;
+@property (readonly, atomic) int	terminationStatus;
+
+@property (readonly, atomic, getter=isRunning) BOOL running;
+
+// -- Life --
+- (BOOL)launch;
+
+- (void)terminate;	// SIGTERM
+- (void)kill;		// SIGKILL
+
+- (void)waitUntilExitWithCompletionHandler:(dispatch_block_t)handler;
+
+@end
+
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,447 @@
+/*
+ *  SMTorProcess.m
+ *
+ *  Copyright 2019 Avérous Julien-Pierre
+ *
+ *  This file is part of SMTor.
+ *
+ *  SMTor is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SMTor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with SMTor.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <spawn.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/wait.h>
+#include <crt_externs.h>
+
+#import "SMTorProcess.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+
+/*
+** Defines
+*/
+#pragma mark - Defines
+
+#define SMTorProcessReadBufferSize	(16 * 1024)
+#define SMTorProcessEnviron			(*_NSGetEnviron())
+
+
+
+/*
+** Prototypes
+*/
+#pragma mark - Prototypes
+
+static BOOL pipe_create(int fds[2]);
+static void pipe_close(int fds[2]);
+
+
+
+/*
+** SMTorProcess - Private
+*/
+#pragma mark - SMTorProcess - Private
+
+@interface SMTorProcess ()
+
+@property (atomic, getter=isRunning) BOOL running;
+
+@end
+
+
+
+/*
+** SMTorProcess
+*/
+#pragma mark - SMTorProcess
+
+@implementation SMTorProcess
+{
+	dispatch_queue_t _localQueue;
+	dispatch_queue_t _handlerQueue;
+	
+	NSString			*_launchPath;
+	NSArray<NSString *>	*_arguments;
+	
+	BOOL _launched;
+	BOOL _exited;
+	
+	dispatch_source_t _exitSource;
+	
+	uint8_t *_readBuffer;
+	
+	NSMutableArray<dispatch_block_t> *_exitHandlers;
+}
+
+
+/*
+** SMTorProcess - Instance
+*/
+#pragma mark - SMTorProcess - Instance
+
+- (instancetype)initWithLaunchPath:(NSString *)launchPath arguments:(NSArray<NSString *> *)arguments
+{
+	self = [super init];
+	
+	if (self)
+	{
+		NSAssert(launchPath, @"launchPath is nil");
+		NSAssert(arguments, @"arguments is nil");
+		
+		// Queues.
+		_localQueue = dispatch_queue_create("com.smtor.tor-process.local", DISPATCH_QUEUE_SERIAL);
+		_handlerQueue = dispatch_queue_create("com.smtor.tor-process.handler", DISPATCH_QUEUE_SERIAL);
+		
+		// Properties.
+		_launchPath = [launchPath copy];
+		_arguments = [arguments copy];
+		
+		_processIdentifier = -1;
+		
+		// Containers.
+		_exitHandlers = [[NSMutableArray alloc] init];
+		
+		// Buffer - shared by the output pipes, as they are read on the same serial handler queue.
+		_readBuffer = malloc(SMTorProcessReadBufferSize);
+	}
+	
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_readBuffer);
+	
+	SMDebugLog(@"SMTorProcess dealloc");
+}
+
+
+
+/*
+** SMTorProcess - Life
+*/
+#pragma mark - SMTorProcess - Life
+
+- (BOOL)launch
+{
+	__block BOOL result;
+	
+	dispatch_sync(_localQueue, ^{
+		@autoreleasepool {
+			result = [self _launch];
+		}
+	});
+	
+	return result;
+}
+
+- (BOOL)_launch
+{
+	// > localQueue <
+	
+	if (_launched)
+		return NO;
+	
+	// Create pipes.
+	SMTorProcessOutputHandler outHandler = self.standardOutputHandler;
+	SMTorProcessOutputHandler errHandler = self.standardErrorHandler;
+	
+	int outPipe[2] = { -1, -1 };
+	int errPipe[2] = { -1, -1 };
+	
+	if ((outHandler && pipe_create(outPipe) == NO) || (errHandler && pipe_create(errPipe) == NO))
+	{
+		pipe_close(outPipe);
+		pipe_close(errPipe);
+		return NO;
+	}
+	
+	// Build file actions.
+	posix_spawn_file_actions_t actions;
+	
+	posix_spawn_file_actions_init(&actions);
+	
+	posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+	
+	if (outPipe[1] != -1)
+		posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+	else
+		posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+	
+	if (errPipe[1] != -1)
+		posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+	else
+		posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+	
+	// Build attributes - reset signals, as ignored ones are inherited (we ignore SIGTERM in the manager), and don't leak our descriptors.
+	posix_spawnattr_t	attributes;
+	sigset_t			noSignals;
+	sigset_t			defaultSignals;
+	short				flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_CLOEXEC_DEFAULT;
+	
+	sigemptyset(&noSignals);
+	
+	sigfillset(&defaultSignals);
+	sigdelset(&defaultSignals, SIGKILL);
+	sigdelset(&defaultSignals, SIGSTOP);
+	
+	posix_spawnattr_init(&attributes);
+	posix_spawnattr_setsigmask(&attributes, &noSignals);
+	posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+	posix_spawnattr_setflags(&attributes, flags);
+	
+	// Build arguments.
+	NSUInteger	argc = _arguments.count + 1;
+	char		**argv = calloc(argc + 1, sizeof(char *));
+	
+	argv[0] = (char *)_launchPath.fileSystemRepresentation;
+	
+	for (NSUInteger i = 0; i < _arguments.count; i++)
+		argv[i + 1] = (char *)_arguments[i].UTF8String;
+	
+	// Spawn.
+	pid_t	pid = -1;
+	int		error = posix_spawn(&pid, argv[0], &actions, &attributes, argv, SMTorProcessEnviron);
+	
+	free(argv);
+	
+	posix_spawnattr_destroy(&attributes);
+	posix_spawn_file_actions_destroy(&actions);
+	
+	// > Child side of the pipes are owned by the child now.
+	if (outPipe[1] != -1)
+		close(outPipe[1]);
+	
+	if (errPipe[1] != -1)
+		close(errPipe[1]);
+	
+	if (error != 0)
+	{
+		if (outPipe[0] != -1)
+			close(outPipe[0]);
+		
+		if (errPipe[0] != -1)
+			close(errPipe[0]);
+		
+		return NO;
+	}
+	
+	_launched = YES;
+	_processIdentifier = pid;
+	
+	self.running = YES;
+	
+	// Monitor output.
+	if (outPipe[0] != -1)
+		[self _monitorFileDescriptor:outPipe[0] handler:outHandler];
+	
+	if (errPipe[0] != -1)
+		[self _monitorFileDescriptor:errPipe[0] handler:errHandler];
+	
+	// Monitor exit.
+	[self _monitorExit];
+	
+	return YES;
+}
+
+- (void)terminate
+{
+	[self _sendSignal:SIGTERM];
+}
+
+- (void)kill
+{
+	[self _sendSignal:SIGKILL];
+}
+
+- (void)waitUntilExitWithCompletionHandler:(dispatch_block_t)handler
+{
+	NSAssert(handler, @"handler is nil");
+	
+	dispatch_async(_localQueue, ^{
+		
+		if (!_launched || _exited)
+			dispatch_async(_handlerQueue, handler);
+		else
+			[_exitHandlers addObject:handler];
+	});
+}
+
+
+
+/*
+** SMTorProcess - Helpers
+*/
+#pragma mark - SMTorProcess - Helpers
+
+- (void)_sendSignal:(int)signal
+{
+	dispatch_async(_localQueue, ^{
+		
+		// The process is reaped on this queue only, so its pid can't have been reused yet.
+		if (_launched && !_exited)
+			kill(_processIdentifier, signal);
+	});
+}
+
+- (void)_monitorFileDescriptor:(int)fd handler:(SMTorProcessOutputHandler)handler
+{
+	// > localQueue <
+	
+	// > Read on the handler queue - handlers can block without stalling our state.
+	dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)fd, 0, _handlerQueue);
+	
+	dispatch_source_set_event_handler(source, ^{
+		
+		ssize_t size = read(fd, _readBuffer, SMTorProcessReadBufferSize);
+		
+		if (size > 0)
+			handler(_readBuffer, (size_t)size);
+		else if (size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+			dispatch_source_cancel(source);
+	});
+	
+	dispatch_source_set_cancel_handler(source, ^{
+		close(fd);
+	});
+	
+	dispatch_resume(source);
+}
+
+- (void)_monitorExit
+{
+	// > localQueue <
+	
+	// Create exit source.
+	_exitSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_PROC, (uintptr_t)_processIdentifier, DISPATCH_PROC_EXIT, _localQueue);
+	
+	dispatch_source_set_event_handler(_exitSource, ^{
+		[self _reap];
+	});
+	
+	dispatch_resume(_exitSource);
+	
+	// The process can have exited before the source was armed.
+	dispatch_async(_localQueue, ^{
+		[self _reap];
+	});
+}
+
+- (void)_reap
+{
+	// > localQueue <
+	
+	if (_exited)
+		return;
+	
+	// Reap.
+	int		status = 0;
+	pid_t	result;
+	
+	do {
+		result = waitpid(_processIdentifier, &status, WNOHANG);
+	} while (result == -1 && errno == EINTR);
+	
+	if (result == 0)
+		return;
+	
+	// Update status.
+	_exited = YES;
+	
+	self.running = NO;
+	
+	if (result == _processIdentifier && WIFEXITED(status))
+		_terminationStatus = WEXITSTATUS(status);
+	else if (result == _processIdentifier && WIFSIGNALED(status))
+		_terminationStatus = WTERMSIG(status);
+	else
+		_terminationStatus = -1;
+	
+	dispatch_source_cancel(_exitSource);
+	_exitSource = nil;
+	
+	// Notify - on the handler queue, so callers can't block our queue.
+	void (^terminationHandler)(SMTorProcess *process) = self.terminationHandler;
+	NSArray<dispatch_block_t> *exitHandlers = [_exitHandlers copy];
+	
+	self.terminationHandler = nil;
+	[_exitHandlers removeAllObjects];
+	
+	dispatch_async(_handlerQueue, ^{
+		
+		if (terminationHandler)
+			terminationHandler(self);
+		
+		for (dispatch_block_t handler in exitHandlers)
+			handler();
+	});
+}
+
+@end
+
+
+NS_ASSUME_NONNULL_END
+
+
+
+/*
+** C Tools
+*/
+#pragma mark - C Tools
+
+static BOOL pipe_create(int fds[2])
+{
+	assert(fds);
+	
+	// Create pipe - both sides are close-on-exec, the child side is dup'ed by posix_spawn.
+	if (pipe(fds) != 0)
+		return NO;
+	
+	if (fcntl(fds[0], F_SETFD, FD_CLOEXEC) == -1 || fcntl(fds[1], F_SETFD, FD_CLOEXEC) == -1)
+	{
+		pipe_close(fds);
+		return NO;
+	}
+	
+	// Our side is non-blocking.
+	int flags = fcntl(fds[0], F_GETFL);
+	
+	if (flags == -1 || fcntl(fds[0], F_SETFL, flags | O_NONBLOCK) == -1)
+	{
+		pipe_close(fds);
+		return NO;
+	}
+	
+	return YES;
+}
+
+static void pipe_close(int fds[2])
+{
+	assert(fds);
+	
+	for (int i = 0; i < 2; i++)
+	{
+		if (fds[i] != -1)
+			close(fds[i]);
+		
+		fds[i] = -1;
+	}
+}
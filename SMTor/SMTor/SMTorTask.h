@@ -36,6 +36,7 @@ NS_ASSUME_NONNULL_BEGIN
 #pragma mark - Forward
 
 @class SMTorConfiguration;
+@class SMTorPerformanceOptions;
 @class SMTorDownloadContext;
 
 
@@ -51,6 +52,11 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)startWithConfiguration:(SMTorConfiguration *)configuration logHandler:(nullable void (^)(SMTorLogKind kind, NSString *log, BOOL fatalLog))logHandler completionHandler:(void (^)(SMInfo *info))handler;
 - (void)stopWithCompletionHandler:(nullable dispatch_block_t)handler;
 
+// -- Configuration --
+@property (atomic) NSTimeInterval shutdownTimeout; // Read when tor is stopped.
+
+- (void)applyPerformanceOptions:(SMTorPerformanceOptions *)options completionHandler:(void (^)(BOOL success))handler;
+
 // -- Download Context --
 - (void)addDownloadContext:(SMTorDownloadContext *)context forKey:(id <NSCopying>)key;
 - (void)removeDownloadContextForKey:(id)key;
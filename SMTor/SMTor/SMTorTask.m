@@ -32,9 +32,11 @@
 
 #import "SMTorControl.h"
 #import "SMTorOperations.h"
+#import "SMTorProcess.h"
 #import "SMTorDownloadContext.h"
 
 #import "SMTorConfiguration.h"
+#import "SMTorPerformanceOptions.h"
 
 #import "SMTorConstants.h"
 
@@ -77,7 +79,8 @@ static NSString *hexa_from_data(NSData *data);
 	
 	BOOL _isRunning;
 	
-	NSTask *_task;
+	SMTorProcess	*_task;
+	SMTorControl	*_control;
 	
 	NSURLSession		*_torURLSession;
 	NSMutableDictionary	*_torDownloadContexts;
@@ -182,15 +185,23 @@ static NSString *hexa_from_data(NSData *data);
 		// -- Stop if running --
 		[operations scheduleOnQueue:_localQueue block:^(SMOperationsControl ctrl) {
 			
+			BOOL wasRunning = _isRunning;
+			
 			// Stop.
-			if (_isRunning)
-				[self _stop];
+			if (wasRunning)
+			{
+				[self _stopWithCompletionHandler:^{
+					ctrl(SMOperationsControlContinue);
+				}];
+			}
 			
 			_isRunning = YES;
 			_currentStartOperation = operations;
+			self.shutdownTimeout = configuration.shutdownTimeout;
 			
 			// Continue.
-			ctrl(SMOperationsControlContinue);
+			if (!wasRunning)
+				ctrl(SMOperationsControlContinue);
 		}];
 		
 		// -- Stage archive --
@@ -294,7 +305,7 @@ static NSString *hexa_from_data(NSData *data);
 		
 		[operations scheduleBlock:^(SMOperationsControl ctrl) {
 			
-			[self.class operationLaunchTorWithConfiguration:configuration logHandler:logHandler completionHandler:^(SMInfo *info, NSTask * _Nullable task, NSString * _Nullable aCtrlKeyHexa) {
+			[self.class operationLaunchTorWithConfiguration:configuration logHandler:logHandler completionHandler:^(SMInfo *info, SMTorProcess * _Nullable task, NSString * _Nullable aCtrlKeyHexa) {
 				
 				if (info.kind == SMInfoError)
 				{
@@ -322,6 +333,7 @@ static NSString *hexa_from_data(NSData *data);
 		// -- Wait control info --
 		__block NSString *torCtrlAddress = nil;
 		__block NSString *torCtrlPort = nil;
+		__block NSString *torCtrlSocketPath = nil;
 		
 		[operations scheduleCancelableBlock:^(SMOperationsControl ctrl, SMOperationsAddCancelBlock addCancelBlock) {
 			
@@ -363,6 +375,32 @@ static NSString *hexa_from_data(NSData *data);
 				}
 				
 				// Try to parse content.
+				if (configuration.controlUnixSocket)
+				{
+					NSRegularExpression		*regExp = [NSRegularExpression regularExpressionWithPattern:@"UNIX_PORT=(.+)" options:NSRegularExpressionCaseInsensitive error:nil];
+					NSTextCheckingResult	*result = [regExp firstMatchInString:ctrlInfo options:0 range:NSMakeRange(0, ctrlInfo.length)];
+					
+					if (!result || result.numberOfRanges < 2)
+					{
+						tryCounter++;
+						return;
+					}
+					
+					// Remove info file once parsed.
+					[[NSFileManager defaultManager] removeItemAtPath:ctrlInfoPath error:nil];
+					
+					// Extract infos.
+					torCtrlSocketPath = [[ctrlInfo substringWithRange:[result rangeAtIndex:1]] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+					
+					// Stop ourself.
+					dispatch_source_cancel(testTimer);
+					
+					// Continue.
+					ctrl(SMOperationsControlContinue);
+					
+					return;
+				}
+				
 				NSRegularExpression *regExp = [NSRegularExpression regularExpressionWithPattern:@"PORT[^=]*=[^0-9]*([0-9\\.]+):([0-9]+)" options:NSRegularExpressionCaseInsensitive error:nil];
 				NSArray				*results = [regExp matchesInString:ctrlInfo options:0 range:NSMakeRange(0, ctrlInfo.length)];
 				
@@ -410,7 +448,10 @@ static NSString *hexa_from_data(NSData *data);
 		[operations scheduleCancelableBlock:^(SMOperationsControl ctrl, SMOperationsAddCancelBlock addCancelBlock) {
 			
 			// Connect control.
-			control = [[SMTorControl alloc] initWithIP:torCtrlAddress port:(uint16_t)torCtrlPort.intValue];
+			if (torCtrlSocketPath)
+				control = [[SMTorControl alloc] initWithUnixSocketPath:torCtrlSocketPath];
+			else
+				control = [[SMTorControl alloc] initWithIP:torCtrlAddress port:(uint16_t)torCtrlPort.intValue];
 			
 			if (!control)
 			{
@@ -445,9 +486,14 @@ static NSString *hexa_from_data(NSData *data);
 		{
 			[operations scheduleCancelableBlock:^(SMOperationsControl ctrl, SMOperationsAddCancelBlock addCancelBlock) {
 				
-				NSString *servicePort = [NSString stringWithFormat:@"%u,%@:%u", configuration.hiddenServiceRemotePort, configuration.hiddenServiceLocalHost, configuration.hiddenServiceLocalPort];
+				NSString *servicePort;
+				
+				if (configuration.hiddenServiceLocalUnixPath)
+					servicePort = [NSString stringWithFormat:@"%u,unix:%@", configuration.hiddenServiceRemotePort, configuration.hiddenServiceLocalUnixPath];
+				else
+					servicePort = [NSString stringWithFormat:@"%u,%@:%u", configuration.hiddenServiceRemotePort, configuration.hiddenServiceLocalHost, configuration.hiddenServiceLocalPort];
 				
-				[control sendAddOnionCommandWithPrivateKey:configuration.hiddenServicePrivateKey port:servicePort resultHandler:^(BOOL success, NSString * _Nullable serviceID, NSString * _Nullable privateKey) {
+				[control sendAddOnionCommandWithPrivateKey:configuration.hiddenServicePrivateKey port:servicePort maxStreams:configuration.performanceOptions.hiddenServiceMaxStreams resultHandler:^(BOOL success, NSString * _Nullable serviceID, NSString * _Nullable privateKey) {
 					
 					if (!success)
 					{
@@ -512,9 +558,16 @@ static NSString *hexa_from_data(NSData *data);
 				// Done.
 				if ([tag isEqualToString:@"done"] && done == NO)
 				{
-					[control stop];
+					// Keep the control connection, so we can ask for a graceful shutdown later.
+					SMTorControl *doneControl = control;
+					
+					doneControl.serverEvent = nil;
 					control = nil;
 					
+					dispatch_async(_localQueue, ^{
+						_control = doneControl;
+					});
+					
 					done = YES;
 
 					ctrl(SMOperationsControlContinue);
@@ -613,19 +666,20 @@ static NSString *hexa_from_data(NSData *data);
 				
 				if (errorInfo || canceled)
 				{
-					if (_task)
-					{
-						objc_setAssociatedObject(_task, &gExpectedTerminationKey, @YES, OBJC_ASSOCIATION_RETAIN);
-						[_task terminate];
-						_task = nil;
-					}
+					// > Continue once tor exited, so the next start can't race with it on the data directory.
+					[self _terminateTask:_task control:_control completionHandler:^{
+						opCtrl(SMOperationsControlContinue);
+					}];
+					
+					_task = nil;
+					_control = nil;
 					
 					_torURLSession = nil;
 					
 					_isRunning = NO;
 				}
-				
-				opCtrl(SMOperationsControlContinue);
+				else
+					opCtrl(SMOperationsControlContinue);
 			});
 		};
 		
@@ -639,20 +693,28 @@ static NSString *hexa_from_data(NSData *data);
 	dispatch_async(_localQueue, ^{
 		
 		// Stop.
-		[self _stop];
+		dispatch_group_t group = dispatch_group_create();
+		
+		dispatch_group_enter(group);
+		
+		[self _stopWithCompletionHandler:^{
+			dispatch_group_leave(group);
+		}];
 		
 		// Wait for completion.
 		if (handler)
 		{
 			[_opQueue scheduleBlock:^(SMOperationsControl ctrl) {
-				handler();
-				ctrl(SMOperationsControlContinue);
+				dispatch_group_notify(group, _localQueue, ^{
+					handler();
+					ctrl(SMOperationsControlContinue);
+				});
 			}];
 		}
 	});
 }
 
-- (void)_stop
+- (void)_stopWithCompletionHandler:(dispatch_block_t)handler
 {
 	// > localQueue <
 	
@@ -660,19 +722,11 @@ static NSString *hexa_from_data(NSData *data);
 	[_currentStartOperation cancel];
 	_currentStartOperation = nil;
 	
-	// Terminate task.
-	@try {
-		if (_task)
-		{
-			objc_setAssociatedObject(_task, &gExpectedTerminationKey, @YES, OBJC_ASSOCIATION_RETAIN);
-			[_task terminate];
-			[_task waitUntilExit];
-		}
-	} @catch (NSException *exception) {
-		NSLog(@"Tor exception on terminate: %@", exception);
-	}
+	// Terminate task - the exit is waited asynchronously, while we tear down the rest.
+	[self _terminateTask:_task control:_control completionHandler:handler];
 	
 	_task = nil;
+	_control = nil;
 	
 	// Remove url session.
 	[_torURLSession invalidateAndCancel];
@@ -682,6 +736,102 @@ static NSString *hexa_from_data(NSData *data);
 	[_torDownloadContexts removeAllObjects];
 }
 
+- (void)_terminateTask:(nullable SMTorProcess *)task control:(nullable SMTorControl *)control completionHandler:(nullable dispatch_block_t)handler
+{
+	// > localQueue <
+	
+	if (!handler)
+		handler = ^{ };
+	
+	// Nothing to terminate - an already exited task is handled by the exit wait.
+	if (!task)
+	{
+		[control stop];
+		dispatch_async(_localQueue, handler);
+		return;
+	}
+	
+	// Flag the termination as expected.
+	objc_setAssociatedObject(task, &gExpectedTerminationKey, @YES, OBJC_ASSOCIATION_RETAIN);
+	
+	// Wait for exit & arm kill timer.
+	__block BOOL		finished = NO;
+	dispatch_source_t	killTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _localQueue);
+	
+	dispatch_block_t finish = ^{
+		
+		if (finished)
+			return;
+		
+		finished = YES;
+		
+		dispatch_source_cancel(killTimer);
+		
+		[control stop];
+		
+		handler();
+	};
+	
+	// > Exit.
+	[task waitUntilExitWithCompletionHandler:^{
+		dispatch_async(_localQueue, finish);
+	}];
+	
+	// > Kill.
+	dispatch_source_set_timer(killTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.shutdownTimeout * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, 0);
+	
+	dispatch_source_set_event_handler(killTimer, ^{
+		
+		SMDebugLog(@"Tor didn't exit in time - kill it");
+		
+		// Finish is called once the process is reaped, so a relaunch can't race with the old one on the data directory.
+		dispatch_source_cancel(killTimer);
+		
+		[task kill];
+	});
+	
+	dispatch_resume(killTimer);
+	
+	// Ask for exit.
+	if (control)
+	{
+		[control sendSignalCommandWithSignal:@"SHUTDOWN" resultHandler:^(BOOL success) {
+			if (!success)
+				[task terminate];
+		}];
+	}
+	else
+		[task terminate];
+}
+
+
+
+/*
+** SMTorTask - Configuration
+*/
+#pragma mark - SMTorTask - Configuration
+
+- (void)applyPerformanceOptions:(SMTorPerformanceOptions *)options completionHandler:(void (^)(BOOL success))handler
+{
+	NSAssert(options, @"options is nil");
+	NSAssert(handler, @"handler is nil");
+	
+	NSDictionary *torOptions = [options torLiveOptions];
+	
+	dispatch_async(_localQueue, ^{
+		
+		// We need a bootstrapped tor to talk to.
+		if (!_control)
+		{
+			handler(NO);
+			return;
+		}
+		
+		// Apply.
+		[_control sendSetConfCommandWithOptions:torOptions resultHandler:handler];
+	});
+}
+
 
 
 /*
@@ -809,7 +959,7 @@ static NSString *hexa_from_data(NSData *data);
 	return YES;
 }
 
-+ (void)operationLaunchTorWithConfiguration:(SMTorConfiguration *)configuration logHandler:(nullable void (^)(SMTorLogKind kind, NSString *log, BOOL fatalLog))logHandler completionHandler:(void (^)(SMInfo *info, NSTask * _Nullable task, NSString * _Nullable ctrlKeyHexa))handler
++ (void)operationLaunchTorWithConfiguration:(SMTorConfiguration *)configuration logHandler:(nullable void (^)(SMTorLogKind kind, NSString *log, BOOL fatalLog))logHandler completionHandler:(void (^)(SMInfo *info, SMTorProcess * _Nullable task, NSString * _Nullable ctrlKeyHexa))handler
 {
 	NSAssert(handler, @"handler is nil");
 	
@@ -834,8 +984,9 @@ static NSString *hexa_from_data(NSData *data);
 	[mng createDirectoryAtPath:dataPath withIntermediateDirectories:NO attributes:nil error:nil];
 	[mng setAttributes:@{ NSFilePosixPermissions : @(0700) } ofItemAtPath:dataPath error:nil];
 	
-	// Clean previous file.
+	// Clean previous files.
 	[mng removeItemAtPath:[dataPath stringByAppendingPathComponent:SMTorControlHostFile] error:nil];
+	[mng removeItemAtPath:[dataPath stringByAppendingPathComponent:SMTorControlSocketFile] error:nil];
 	
 	// Create control password.
 	NSMutableData	*ctrlPassword = [[NSMutableData alloc] initWithLength:32];
@@ -848,72 +999,39 @@ static NSString *hexa_from_data(NSData *data);
 	hexaPassword = hexa_from_data(ctrlPassword);
 	
 	// Log snippet.
-	dispatch_queue_t logQueue = dispatch_queue_create("com.smtor.tor-task.output", DISPATCH_QUEUE_SERIAL);
-	
-	void (^handleLog)(NSFileHandle *, NSMutableString *buffer, SMTorLogKind) = ^(NSFileHandle *handle, NSMutableString *buffer, SMTorLogKind kind) {
+	void (^handleLog)(NSMutableData *, const void *, size_t, SMTorLogKind) = ^(NSMutableData *buffer, const void *bytes, size_t size, SMTorLogKind kind) {
 		
-		NSData *data;
+		[buffer appendBytes:bytes length:size];
 		
-		@try {
-			data = handle.availableData;
-		}
-		@catch (NSException *exception) {
-			handle.readabilityHandler = nil;
-			return;
-		}
+		// Extract lines.
+		const char	*start = buffer.bytes;
+		const char	*end = start + buffer.length;
+		const char	*cursor = start;
+		const char	*separator;
 		
-		// Parse data.
-		dispatch_async(logQueue, ^{
-			
-			NSString *strData = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+		while ((separator = memchr(cursor, '\n', (size_t)(end - cursor))))
+		{
+			size_t length = (size_t)(separator - cursor);
 			
-			if (strData)
-				[buffer appendString:strData];
+			if (length > 0 && cursor[length - 1] == '\r')
+				length--;
 			
-			while (1)
+			if (length > 0)
 			{
-				NSRange lineSeparator = [buffer rangeOfCharacterFromSet:[NSCharacterSet newlineCharacterSet]];
-				
-				if (lineSeparator.location == NSNotFound)
-					break;
+				NSString *line = [[NSString alloc] initWithBytes:cursor length:length encoding:NSUTF8StringEncoding];
 				
-				NSString *line = [buffer substringToIndex:lineSeparator.location];
-				
-				if (line.length > 0)
+				if (line)
 					logHandler(kind, line, NO);
-				
-				[buffer deleteCharactersInRange:NSMakeRange(0, lineSeparator.location + lineSeparator.length)];
 			}
-		});
-	};
-	
-	// Build tor task.
-	NSTask *task = [[NSTask alloc] init];
-	
-	// > handle output.
-	if (logHandler)
-	{
-		NSPipe		*errPipe = [[NSPipe alloc] init];
-		NSPipe		*outPipe = [[NSPipe alloc] init];
-		NSMutableString	*errBuffer = [[NSMutableString alloc] init];
-		NSMutableString	*outBuffer = [[NSMutableString alloc] init];
-		
-		NSFileHandle *errHandle = errPipe.fileHandleForReading;
-		NSFileHandle *outHandle = outPipe.fileHandleForReading;
-		
-		errHandle.readabilityHandler = ^(NSFileHandle *handle) { handleLog(handle, errBuffer, SMTorLogError); };
-		outHandle.readabilityHandler = ^(NSFileHandle *handle) { handleLog(handle, outBuffer, SMTorLogStandard); };
+			
+			cursor = separator + 1;
+		}
 		
-		task.standardError = errPipe;
-		task.standardOutput = outPipe;
-	}
-	
-	// > Set launch path.
-	NSString *torExecPath = [[binaryPath stringByAppendingPathComponent:SMTorFileBinBinaries] stringByAppendingPathComponent:SMTorFileBinTor];
-	
-	task.launchPath = torExecPath;
+		// Keep remaining partial line.
+		[buffer replaceBytesInRange:NSMakeRange(0, (NSUInteger)(cursor - start)) withBytes:NULL length:0];
+	};
 	
-	// > Set arguments.
+	// Build arguments.
 	NSMutableArray *args = [NSMutableArray array];
 	
 	[args addObject:@"--ClientOnly"];
@@ -930,7 +1048,16 @@ static NSString *hexa_from_data(NSData *data);
 	[args addObject:dataPath];
 	
 	[args addObject:@"--ControlPort"];
-	[args addObject:@"auto"];
+	
+	if (configuration.controlUnixSocket)
+	{
+		[args addObject:@"0"];
+		
+		[args addObject:@"--ControlSocket"];
+		[args addObject:[dataPath stringByAppendingPathComponent:SMTorControlSocketFile]];
+	}
+	else
+		[args addObject:@"auto"];
 	
 	[args addObject:@"--ControlPortWriteToFile"];
 	[args addObject:[dataPath stringByAppendingPathComponent:SMTorControlHostFile]];
@@ -938,9 +1065,24 @@ static NSString *hexa_from_data(NSData *data);
 	[args addObject:@"--HashedControlPassword"];
 	[args addObject:hashedPassword];
 	
-	task.arguments = args;
+	[args addObjectsFromArray:[configuration.performanceOptions torArguments]];
+	
+	// Build tor process.
+	NSString		*torExecPath = [[binaryPath stringByAppendingPathComponent:SMTorFileBinBinaries] stringByAppendingPathComponent:SMTorFileBinTor];
+	SMTorProcess	*task = [[SMTorProcess alloc] initWithLaunchPath:torExecPath arguments:args];
 	
-	task.terminationHandler = ^(NSTask *atask) {
+	// > handle output.
+	if (logHandler)
+	{
+		NSMutableData *errBuffer = [[NSMutableData alloc] init];
+		NSMutableData *outBuffer = [[NSMutableData alloc] init];
+		
+		task.standardErrorHandler = ^(const void *bytes, size_t size) { handleLog(errBuffer, bytes, size, SMTorLogError); };
+		task.standardOutputHandler = ^(const void *bytes, size_t size) { handleLog(outBuffer, bytes, size, SMTorLogStandard); };
+	}
+	
+	// > handle termination.
+	task.terminationHandler = ^(SMTorProcess *atask) {
 		
 		if (!logHandler)
 			return;
@@ -951,11 +1093,9 @@ static NSString *hexa_from_data(NSData *data);
 			logHandler(SMTorLogError, [NSString stringWithFormat:SMLocalizedString(@"log_tor_unexpected_termination", @""), atask.terminationStatus], YES);
 	};
 	
-	
-	// Run tor task.
-	@try {
-		[task launch];
-	} @catch (NSException *exception) {
+	// Run tor process.
+	if ([task launch] == NO)
+	{
 		handler([SMInfo infoOfKind:SMInfoError domain:SMTorInfoOperationDomain code:SMTorErrorOperationTor context:@(-1)], nil, nil);
 		return;
 	}